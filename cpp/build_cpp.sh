@@ -1,2 +1,2 @@
 #!/bin/bash
-g++ -Wall -Werror -o main.o main.cpp
+g++ -Wall -Werror -O2 -pthread -o main.o main.cpp
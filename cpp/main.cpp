@@ -8,7 +8,69 @@
 #include<vector>
 #include<utility>
 #include<optional>
+#include<memory>
+#include<map>
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+#include<atomic>
+#include<new>
+#include<cstdlib>
+#include<cerrno>
+#include<cstdint>
+#include<cstdarg>
+#include<chrono>
 #include<stdio.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/socket.h>
+#include<sys/stat.h>
+#include<sys/un.h>
+
+// counts every heap allocation made through operator new so a run can report
+// how many allocations each generation needed
+std::atomic<size_t> allocation_count(0);
+
+void* operator new(size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// per cell debug output of the sparse engine, disabled with --quiet
+bool trace_enabled = true;
+
+__attribute__((format(printf, 1, 2)))
+void trace(const char* format, ...)
+{
+    if (!trace_enabled)
+    {
+        return;
+    }
+
+    va_list args;
+
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
 
 struct Coord
 {
@@ -97,6 +159,322 @@ enum class Direction {
     SE
 };
 
+// a board backed by an anonymous mapping. the kernel hands out zeroed pages
+// the first time they are touched so the parts of a huge board that a pattern
+// never reaches take no physical memory. indexed by column like the nested
+// vectors it replaces, grid[x][y]
+struct Grid
+{
+    size_t x_size = 0;
+    size_t y_size = 0;
+    size_t bytes = 0;
+    unsigned char* cells = nullptr;
+
+    Grid(size_t x_size, size_t y_size) :
+        x_size(x_size), y_size(y_size)
+    {
+        if (y_size != 0 && x_size > SIZE_MAX / y_size)
+        {
+            throw std::bad_alloc();
+        }
+
+        this->bytes = x_size * y_size;
+
+        if (this->bytes == 0)
+        {
+            return;
+        }
+
+        void* mapped = mmap(
+            nullptr,
+            this->bytes,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+            -1,
+            0
+        );
+
+        if (mapped == MAP_FAILED)
+        {
+            throw std::bad_alloc();
+        }
+
+        this->cells = (unsigned char*)mapped;
+    }
+
+    Grid(const Grid&) = delete;
+    Grid& operator=(const Grid&) = delete;
+
+    ~Grid()
+    {
+        if (this->cells != nullptr)
+        {
+            munmap(this->cells, this->bytes);
+        }
+    }
+
+    unsigned char* operator[](size_t x)
+    {
+        return this->cells + x * this->y_size;
+    }
+
+    const unsigned char* operator[](size_t x) const
+    {
+        return this->cells + x * this->y_size;
+    }
+
+    void swap(Grid& other)
+    {
+        std::swap(this->x_size, other.x_size);
+        std::swap(this->y_size, other.y_size);
+        std::swap(this->bytes, other.bytes);
+        std::swap(this->cells, other.cells);
+    }
+
+    void clear()
+    {
+        std::fill(this->cells, this->cells + this->bytes, 0);
+    }
+};
+
+// birth and survival conditions as bit masks indexed by the number of live
+// neighbours. defaults to conway's B3/S23
+struct Rule
+{
+    unsigned short birth = 1 << 3;
+    unsigned short survive = (1 << 2) | (1 << 3);
+
+    bool next(bool alive, unsigned char neighbours) const
+    {
+        if (alive)
+        {
+            return this->survive & (1 << neighbours);
+        }
+
+        return this->birth & (1 << neighbours);
+    }
+};
+
+// larger than life rule in the R,C,M,S,B,N notation, for example bosco's
+// rule R5,C0,M1,S34..58,B34..45,NM. only two states (C0 or C2) and the moore
+// neighbourhood (NM) are supported. the defaults are conway's life
+struct LtlRule
+{
+    // same limit as golly, also keeps the neighbourhood bounds from wrapping
+    static constexpr size_t MAX_RADIUS = 500;
+
+    size_t radius = 1;
+    bool middle = false;
+    size_t survive_min = 2;
+    size_t survive_max = 3;
+    size_t birth_min = 3;
+    size_t birth_max = 3;
+
+    bool next(bool alive, size_t neighbours) const
+    {
+        if (alive)
+        {
+            return neighbours >= this->survive_min && neighbours <= this->survive_max;
+        }
+
+        return neighbours >= this->birth_min && neighbours <= this->birth_max;
+    }
+};
+
+// reads a plain run of digits, sscanf's %zu would also take signs and
+// whitespace so "-1" would come back as SIZE_MAX
+bool parse_rule_number(const std::string& digits, size_t& value)
+{
+    if (digits.empty() || digits.size() > 9 || digits.find_first_not_of("0123456789") != std::string::npos)
+    {
+        return false;
+    }
+
+    value = std::stoul(digits);
+    return true;
+}
+
+// reads the "min..max" part of a survival or birth field
+bool parse_rule_range(const std::string& range, size_t& min, size_t& max)
+{
+    size_t dots = range.find("..");
+
+    if (dots == std::string::npos)
+    {
+        return false;
+    }
+
+    return parse_rule_number(range.substr(0, dots), min) &&
+        parse_rule_number(range.substr(dots + 2), max) &&
+        min <= max;
+}
+
+std::optional<LtlRule> parse_ltl_rule(const std::string& notation)
+{
+    LtlRule rule;
+    std::istringstream input(notation);
+    std::string part;
+    bool has_radius = false;
+    bool has_survive = false;
+    bool has_birth = false;
+
+    while (std::getline(input, part, ','))
+    {
+        size_t value = 0;
+
+        if (part.empty())
+        {
+            return std::nullopt;
+        }
+
+        switch (part[0])
+        {
+            case 'R':
+                if (!parse_rule_number(part.substr(1), value) || value == 0 || value > LtlRule::MAX_RADIUS)
+                {
+                    return std::nullopt;
+                }
+
+                rule.radius = value;
+                has_radius = true;
+                break;
+            case 'C':
+                // anything above two states is a generations rule
+                if (!parse_rule_number(part.substr(1), value) || value > 2)
+                {
+                    return std::nullopt;
+                }
+
+                break;
+            case 'M':
+                if (!parse_rule_number(part.substr(1), value) || value > 1)
+                {
+                    return std::nullopt;
+                }
+
+                rule.middle = value == 1;
+                break;
+            case 'S':
+                if (!parse_rule_range(part.substr(1), rule.survive_min, rule.survive_max))
+                {
+                    return std::nullopt;
+                }
+
+                has_survive = true;
+                break;
+            case 'B':
+                if (!parse_rule_range(part.substr(1), rule.birth_min, rule.birth_max))
+                {
+                    return std::nullopt;
+                }
+
+                has_birth = true;
+                break;
+            case 'N':
+                if (part != "NM")
+                {
+                    return std::nullopt;
+                }
+
+                break;
+            default:
+                return std::nullopt;
+        }
+    }
+
+    // C, M and N have sensible defaults, the rest is what defines the rule
+    if (!has_radius || !has_survive || !has_birth)
+    {
+        return std::nullopt;
+    }
+
+    return rule;
+}
+
+// maps every 4x4 neighbourhood to the next state of its inner 2x2 block.
+// the index holds one column per nibble, top row in the lowest bit:
+//
+//  0  4  8 12
+//  1  5  9 13
+//  2  6 10 14
+//  3  7 11 15
+//
+// the result holds the inner cells 5, 6, 9, 10 in bits 0 to 3
+struct LookupTable
+{
+    static constexpr size_t SIZE = 1 << 16;
+
+    std::vector<unsigned char> next;
+
+    LookupTable(const Rule& rule) :
+        next(SIZE)
+    {
+        for (size_t index = 0; index < SIZE; ++index)
+        {
+            unsigned char result = 0;
+            unsigned char bit = 0;
+
+            for (size_t col = 1; col <= 2; ++col)
+            {
+                for (size_t row = 1; row <= 2; ++row)
+                {
+                    unsigned char neighbours = 0;
+
+                    for (size_t x = col - 1; x <= col + 1; ++x)
+                    {
+                        for (size_t y = row - 1; y <= row + 1; ++y)
+                        {
+                            if ((x != col || y != row) && (index >> (x * 4 + y)) & 1)
+                            {
+                                neighbours += 1;
+                            }
+                        }
+                    }
+
+                    if (rule.next((index >> (col * 4 + row)) & 1, neighbours))
+                    {
+                        result |= 1 << bit;
+                    }
+
+                    bit += 1;
+                }
+            }
+
+            this->next[index] = result;
+        }
+    }
+};
+
+// keeps the population of the last few generations so the alive lists can be
+// sized up front instead of growing while a generation is processed
+struct PopulationHistory
+{
+    static constexpr size_t LENGTH = 16;
+
+    size_t populations[LENGTH] = {};
+    size_t count = 0;
+
+    void record(size_t population)
+    {
+        this->populations[this->count % LENGTH] = population;
+        this->count += 1;
+    }
+
+    size_t predict()
+    {
+        size_t recorded = std::min(this->count, LENGTH);
+        size_t largest = 0;
+
+        for (size_t index = 0; index < recorded; ++index)
+        {
+            largest = std::max(largest, this->populations[index]);
+        }
+
+        // leave some headroom for growing patterns
+        return largest + largest / 4 + 16;
+    }
+};
+
 struct World
 {
     size_t x_size = 0;
@@ -104,15 +482,38 @@ struct World
     size_t x_max = 0;
     size_t y_max = 0;
 
-    std::vector<std::vector<unsigned char>> grid;
-    std::vector<std::vector<unsigned char>> next_grid;
+    Grid grid;
+    Grid next_grid;
+    std::vector<Coord> previous_alive;
     std::vector<Coord> alive;
     std::vector<Coord> next_alive;
+    PopulationHistory history;
+    Rule rule;
+
+    // stands in for the columns outside of the board, always dead
+    std::vector<unsigned char> empty_column;
+
+    // scratch tiles of the temporal engine, sized on first use
+    std::vector<unsigned char> tile_current;
+    std::vector<unsigned char> tile_next;
+
+    // summed area table of the larger than life engine, sized on first use
+    std::vector<uint32_t> area_sums;
+
+    // old state of three columns around the one the in place engine is
+    // writing, with a dead cell above and below each
+    std::vector<unsigned char> rolling_columns;
+
+    // live cells on the board. the dense engines do not keep the alive
+    // lists and count the cells they write to next_grid instead
+    size_t population = 0;
+    size_t next_population = 0;
 
     World(size_t x_size, size_t y_size) :
         x_size(x_size), y_size(y_size),
-        grid(x_size, std::vector<unsigned char>(y_size)),
-        next_grid(x_size, std::vector<unsigned char>(y_size))
+        grid(x_size, y_size),
+        next_grid(x_size, y_size),
+        empty_column(y_size)
     {
         if (x_size != 0)
         {
@@ -152,7 +553,7 @@ struct World
             return false;
         }
 
-        printf("spawning cell at %zu:%zu\n", cell.x, cell.y);
+        trace("spawning cell at %zu:%zu\n", cell.x, cell.y);
 
         this->set_alive(cell);
         this->next_alive.push_back(cell);
@@ -164,29 +565,19 @@ struct World
     {
         if (this->is_checked(check))
         {
-            printf("try spawn %zu:%zu already checked\n", check.x, check.y);
+            trace("try spawn %zu:%zu already checked\n", check.x, check.y);
             return false;
         }
 
-        printf("try spawning %zu:%zu", check.x, check.y);
+        trace("try spawning %zu:%zu", check.x, check.y);
 
         unsigned char neighbours = this->neighbours(check);
 
         this->set_checked(check);
 
-        if (this->grid[check.x][check.y] & CELL_ALIVE)
-        {
-            if (neighbours == 2 || neighbours == 3)
-            {
-                return this->spawn(check);
-            }
-        }
-        else
+        if (this->rule.next(this->grid[check.x][check.y] & CELL_ALIVE, neighbours))
         {
-            if (neighbours == 3)
-            {
-                return this->spawn(check);
-            }
+            return this->spawn(check);
         }
 
         return false;
@@ -256,19 +647,19 @@ struct World
                 // x x
                 if (this->neighbour_alive(cell, Direction::E))
                 {
-                    printf(" e[%u]", this->get_neighbour(cell, Direction::E));
+                    trace(" e[%u]", this->get_neighbour(cell, Direction::E));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::S))
                 {
-                    printf(" s[%u]", this->get_neighbour(cell, Direction::S));
+                    trace(" s[%u]", this->get_neighbour(cell, Direction::S));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::SE))
                 {
-                    printf(" se[%u]", this->get_neighbour(cell, Direction::SE));
+                    trace(" se[%u]", this->get_neighbour(cell, Direction::SE));
                     neighbours += 1;
                 }
             }
@@ -278,19 +669,19 @@ struct World
                 // o x
                 if (this->neighbour_alive(cell, Direction::N))
                 {
-                    printf(" n[%u]", this->get_neighbour(cell, Direction::N));
+                    trace(" n[%u]", this->get_neighbour(cell, Direction::N));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::NE))
                 {
-                    printf(" ne[%u]", this->get_neighbour(cell, Direction::NE));
+                    trace(" ne[%u]", this->get_neighbour(cell, Direction::NE));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::E))
                 {
-                    printf(" e[%u]", this->get_neighbour(cell, Direction::E));
+                    trace(" e[%u]", this->get_neighbour(cell, Direction::E));
                     neighbours += 1;
                 }
             }
@@ -301,31 +692,31 @@ struct World
                 // x x
                 if (this->neighbour_alive(cell, Direction::N))
                 {
-                    printf(" n[%u]", this->get_neighbour(cell, Direction::N));
+                    trace(" n[%u]", this->get_neighbour(cell, Direction::N));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::NE))
                 {
-                    printf(" ne[%u]", this->get_neighbour(cell, Direction::NE));
+                    trace(" ne[%u]", this->get_neighbour(cell, Direction::NE));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::E))
                 {
-                    printf(" e[%u]", this->get_neighbour(cell, Direction::E));
+                    trace(" e[%u]", this->get_neighbour(cell, Direction::E));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::S))
                 {
-                    printf(" s[%u]", this->get_neighbour(cell, Direction::S));
+                    trace(" s[%u]", this->get_neighbour(cell, Direction::S));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::SE))
                 {
-                    printf(" se[%u]", this->get_neighbour(cell, Direction::SE));
+                    trace(" se[%u]", this->get_neighbour(cell, Direction::SE));
                     neighbours += 1;
                 }
             }
@@ -338,19 +729,19 @@ struct World
                 // x x
                 if (this->neighbour_alive(cell, Direction::W))
                 {
-                    printf(" w[%u]", this->get_neighbour(cell, Direction::W));
+                    trace(" w[%u]", this->get_neighbour(cell, Direction::W));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::SW))
                 {
-                    printf(" sw[%u]", this->get_neighbour(cell, Direction::SW));
+                    trace(" sw[%u]", this->get_neighbour(cell, Direction::SW));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::S))
                 {
-                    printf(" s[%u]", this->get_neighbour(cell, Direction::S));
+                    trace(" s[%u]", this->get_neighbour(cell, Direction::S));
                     neighbours += 1;
                 }
             }
@@ -360,19 +751,19 @@ struct World
                 // x o
                 if (this->neighbour_alive(cell, Direction::NW))
                 {
-                    printf(" nw[%u]", this->get_neighbour(cell, Direction::NW));
+                    trace(" nw[%u]", this->get_neighbour(cell, Direction::NW));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::N))
                 {
-                    printf(" n[%u]", this->get_neighbour(cell, Direction::N));
+                    trace(" n[%u]", this->get_neighbour(cell, Direction::N));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::W))
                 {
-                    printf(" w[%u]", this->get_neighbour(cell, Direction::W));
+                    trace(" w[%u]", this->get_neighbour(cell, Direction::W));
                     neighbours += 1;
                 }
             }
@@ -383,31 +774,31 @@ struct World
                 // x x
                 if (this->neighbour_alive(cell, Direction::NW))
                 {
-                    printf(" nw[%u]", this->get_neighbour(cell, Direction::NW));
+                    trace(" nw[%u]", this->get_neighbour(cell, Direction::NW));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::N))
                 {
-                    printf(" n[%u]", this->get_neighbour(cell, Direction::N));
+                    trace(" n[%u]", this->get_neighbour(cell, Direction::N));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::W))
                 {
-                    printf(" w[%u]", this->get_neighbour(cell, Direction::W));
+                    trace(" w[%u]", this->get_neighbour(cell, Direction::W));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::SW))
                 {
-                    printf(" sw[%u]", this->get_neighbour(cell, Direction::SW));
+                    trace(" sw[%u]", this->get_neighbour(cell, Direction::SW));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::S))
                 {
-                    printf(" s[%u]", this->get_neighbour(cell, Direction::S));
+                    trace(" s[%u]", this->get_neighbour(cell, Direction::S));
                     neighbours += 1;
                 }
             }
@@ -420,31 +811,31 @@ struct World
                 // x x x
                 if (this->neighbour_alive(cell, Direction::W))
                 {
-                    printf(" w[%u]", this->get_neighbour(cell, Direction::W));
+                    trace(" w[%u]", this->get_neighbour(cell, Direction::W));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::E))
                 {
-                    printf(" e[%u]", this->get_neighbour(cell, Direction::E));
+                    trace(" e[%u]", this->get_neighbour(cell, Direction::E));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::SW))
                 {
-                    printf(" sw[%u]", this->get_neighbour(cell, Direction::SW));
+                    trace(" sw[%u]", this->get_neighbour(cell, Direction::SW));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::S))
                 {
-                    printf(" s[%u]", this->get_neighbour(cell, Direction::S));
+                    trace(" s[%u]", this->get_neighbour(cell, Direction::S));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::SE))
                 {
-                    printf(" se[%u]", this->get_neighbour(cell, Direction::SE));
+                    trace(" se[%u]", this->get_neighbour(cell, Direction::SE));
                     neighbours += 1;
                 }
             }
@@ -454,31 +845,31 @@ struct World
                 // x o x
                 if (this->neighbour_alive(cell, Direction::NW))
                 {
-                    printf(" nw[%u]", this->get_neighbour(cell, Direction::NW));
+                    trace(" nw[%u]", this->get_neighbour(cell, Direction::NW));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::N))
                 {
-                    printf(" n[%u]", this->get_neighbour(cell, Direction::N));
+                    trace(" n[%u]", this->get_neighbour(cell, Direction::N));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::NE))
                 {
-                    printf(" ne[%u]", this->get_neighbour(cell, Direction::NE));
+                    trace(" ne[%u]", this->get_neighbour(cell, Direction::NE));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::W))
                 {
-                    printf(" w[%u]", this->get_neighbour(cell, Direction::W));
+                    trace(" w[%u]", this->get_neighbour(cell, Direction::W));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::E))
                 {
-                    printf(" e[%u]", this->get_neighbour(cell, Direction::E));
+                    trace(" e[%u]", this->get_neighbour(cell, Direction::E));
                     neighbours += 1;
                 }
             }
@@ -489,62 +880,62 @@ struct World
                 // x x x
                 if (this->neighbour_alive(cell, Direction::NW))
                 {
-                    printf(" nw[%u]", this->get_neighbour(cell, Direction::NW));
+                    trace(" nw[%u]", this->get_neighbour(cell, Direction::NW));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::N))
                 {
-                    printf(" n[%u]", this->get_neighbour(cell, Direction::N));
+                    trace(" n[%u]", this->get_neighbour(cell, Direction::N));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::NE))
                 {
-                    printf(" ne[%u]", this->get_neighbour(cell, Direction::NE));
+                    trace(" ne[%u]", this->get_neighbour(cell, Direction::NE));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::W))
                 {
-                    printf(" w[%u]", this->get_neighbour(cell, Direction::W));
+                    trace(" w[%u]", this->get_neighbour(cell, Direction::W));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::E))
                 {
-                    printf(" e[%u]", this->get_neighbour(cell, Direction::E));
+                    trace(" e[%u]", this->get_neighbour(cell, Direction::E));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::SW))
                 {
-                    printf(" sw[%u]", this->get_neighbour(cell, Direction::SW));
+                    trace(" sw[%u]", this->get_neighbour(cell, Direction::SW));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::S))
                 {
-                    printf(" s[%u]", this->get_neighbour(cell, Direction::S));
+                    trace(" s[%u]", this->get_neighbour(cell, Direction::S));
                     neighbours += 1;
                 }
 
                 if (this->neighbour_alive(cell, Direction::SE))
                 {
-                    printf(" se[%u]", this->get_neighbour(cell, Direction::SE));
+                    trace(" se[%u]", this->get_neighbour(cell, Direction::SE));
                     neighbours += 1;
                 }
             }
         }
 
-        printf(" %u\n", neighbours);
+        trace(" %u\n", neighbours);
 
         return neighbours;
     }
 
     void tick()
     {
-        printf("currently alive cells: %zu\n", this->alive.size());
+        trace("currently alive cells: %zu\n", this->alive.size());
 
         for (size_t index = 0; index < this->alive.size(); ++index)
         {
@@ -700,151 +1091,2087 @@ struct World
         }
     }
 
-    void update()
+    // dense engine that steps the whole board two columns and two rows at a
+    // time using a LookupTable built from the world rule
+    void tick_lookup(const LookupTable& table)
     {
-        this->grid.swap(this->next_grid);
-        this->alive.swap(this->next_alive);
+        const unsigned char* columns[4];
 
-        for (size_t col = 0; col < this->x_size; ++col)
+        for (size_t x = 0; x < this->x_size; x += 2)
         {
-            std::fill(this->next_grid[col].begin(), this->next_grid[col].end(), 0);
-        }
+            for (size_t offset = 0; offset < 4; ++offset)
+            {
+                // x - 1 wraps around for the first column and is caught here
+                size_t col = x + offset - 1;
 
-        this->next_alive.clear();
-    }
+                columns[offset] = col < this->x_size ?
+                    this->grid[col] :
+                    this->empty_column.data();
+            }
 
-    bool to_file(std::string file_name)
-    {
-        std::ofstream file(file_name);
+            // start as if the previous block covered rows -3 to 0
+            size_t index = 0;
 
-        if (!file.is_open())
-        {
-            return false;
-        }
+            for (size_t offset = 0; offset < 4; ++offset)
+            {
+                index |= (columns[offset][0] & CELL_ALIVE) << (offset * 4 + 3);
+            }
 
-        for (size_t y_index = 0; y_index < this->y_size; ++y_index)
-        {
-            for (size_t x_index = 0; x_index < this->x_size; ++x_index)
+            for (size_t y = 0; y < this->y_size; y += 2)
             {
-                if (this->grid[x_index][y_index] & CELL_ALIVE)
+                // shift every column up two rows and load the next two
+                index = (index >> 2) & 0x3333;
+
+                if (y + 2 < this->y_size)
                 {
-                    file << '1';
+                    for (size_t offset = 0; offset < 4; ++offset)
+                    {
+                        index |= (columns[offset][y + 1] & CELL_ALIVE) << (offset * 4 + 2);
+                        index |= (columns[offset][y + 2] & CELL_ALIVE) << (offset * 4 + 3);
+                    }
                 }
-                else
+                else if (y + 1 < this->y_size)
                 {
-                    file << ' ';
+                    for (size_t offset = 0; offset < 4; ++offset)
+                    {
+                        index |= (columns[offset][y + 1] & CELL_ALIVE) << (offset * 4 + 2);
+                    }
                 }
-            }
 
-            file << '\n';
-        }
-
-        file.close();
+                unsigned char result = table.next[index];
 
-        return true;
+                this->set_block(x, y, result);
+            }
+        }
     }
-};
 
-int main(int argc, char** argv)
-{
-    size_t generations = 2;
-
-    if (argc < 2)
+    // dense engine that advances the board several generations per call. the
+    // board is processed in tiles of tile_size cells that are loaded with a
+    // halo of one cell per generation, stepped in a local buffer that stays
+    // in cache and written back without the halo, which is no longer valid.
+    // the halo reaches past the tile so the result matches stepping one
+    // generation at a time
+    void tick_temporal(size_t generations, size_t tile_size)
     {
-        printf("provide a file to start the game\n");
-        return 0;
-    }
+        // neither the tile nor the halo can be larger than the board, which
+        // also keeps huge --tile and --depth values from sizing the buffers
+        size_t board_size = std::max(this->x_size, this->y_size);
 
-    std::ifstream input_file(argv[1]);
+        tile_size = std::min(tile_size, board_size);
 
-    if (!input_file.is_open())
-    {
-        printf("failed to open start file \"%s\"\n", argv[1]);
-        return 0;
-    }
+        // one more cell on every side that stays dead, so cells on the edge
+        // of the board need no special case
+        size_t padded = tile_size + 2 * std::min(generations, board_size) + 2;
 
-    if (argc == 3)
-    {
-        if (1 != sscanf(argv[2], "%zu", &generations))
+        this->tile_current.resize(padded * padded);
+        this->tile_next.resize(padded * padded);
+
+        for (size_t tile_x = 0; tile_x < this->x_size; tile_x += tile_size)
         {
-            printf("failed to parse generations amount \"%s\"", argv[2]);
-            return 0;
+            for (size_t tile_y = 0; tile_y < this->y_size; tile_y += tile_size)
+            {
+                this->step_tile(tile_x, tile_y, tile_size, generations, padded);
+            }
         }
     }
 
-    if (generations == 0)
+    void step_tile(size_t tile_x, size_t tile_y, size_t tile_size, size_t generations, size_t padded)
     {
-        printf("generations specified is zero\n");
-        return 0;
-    }
+        size_t core_x_end = std::min(tile_x + tile_size, this->x_size);
+        size_t core_y_end = std::min(tile_y + tile_size, this->y_size);
 
-    std::string line;
-    size_t x_size = 0;
-    size_t y_size = 0;
+        // the halo is clipped to the board, cells past the edge are dead
+        size_t halo = std::min(generations, std::max(this->x_size, this->y_size));
+        size_t halo_x = tile_x < halo ? 0 : tile_x - halo;
+        size_t halo_y = tile_y < halo ? 0 : tile_y - halo;
+        size_t halo_x_end = std::min(core_x_end + halo, this->x_size);
+        size_t halo_y_end = std::min(core_y_end + halo, this->y_size);
 
-    // get the grid size
-    if (std::getline(input_file, line)) 
-    {
-        if (2 != sscanf(line.c_str(), "%zu:%zu", &x_size, &y_size))
+        size_t width = halo_x_end - halo_x;
+        size_t height = halo_y_end - halo_y;
+
+        for (std::vector<unsigned char>* local : {&this->tile_current, &this->tile_next})
         {
-            printf("invalid grid size of first line of file\n");
-            return 0;
+            // clear the dead ring around the halo left over from a larger tile
+            std::fill(local->begin(), local->begin() + height + 2, 0);
+            std::fill(local->begin() + (width + 1) * padded, local->begin() + (width + 1) * padded + height + 2, 0);
+
+            for (size_t x = 1; x <= width; ++x)
+            {
+                (*local)[x * padded] = 0;
+                (*local)[x * padded + height + 1] = 0;
+            }
         }
 
-        if (x_size < 3 || y_size < 3)
+        for (size_t x = 0; x < width; ++x)
         {
-            printf("grid size is too small. x and y must be greater than 3");
-            return 0;
-        }
-    }
-    else
-    {
-        printf("failed to read first line of file\n");
-        return 0;
-    }
+            const unsigned char* column = this->grid[halo_x + x] + halo_y;
+            unsigned char* local = this->tile_current.data() + (x + 1) * padded + 1;
 
-    World world(x_size, y_size);
-    Coord pos(0, 0);
+            for (size_t y = 0; y < height; ++y)
+            {
+                local[y] = column[y] & CELL_ALIVE;
+            }
+        }
 
-    while (std::getline(input_file, line))
-    {
-        if (2 != sscanf(line.c_str(), "%zu,%zu", &pos.x, &pos.y))
+        for (size_t step = 1; step <= generations; ++step)
         {
-            printf("failed to parse coordinate %s", line.c_str());
-            return 0;
-        }
+            // every step invalidates another ring of the halo, except where
+            // the halo ends at the board edge
+            size_t x_start = 1 + (halo_x == 0 ? 0 : step);
+            size_t y_start = 1 + (halo_y == 0 ? 0 : step);
+            size_t x_end = 1 + width - (halo_x_end == this->x_size ? 0 : step);
+            size_t y_end = 1 + height - (halo_y_end == this->y_size ? 0 : step);
+
+            for (size_t x = x_start; x < x_end; ++x)
+            {
+                const unsigned char* west = this->tile_current.data() + (x - 1) * padded;
+                const unsigned char* centre = west + padded;
+                const unsigned char* east = centre + padded;
+                unsigned char* next = this->tile_next.data() + x * padded;
 
-        world.spawn(pos);
-    }
+                for (size_t y = y_start; y < y_end; ++y)
+                {
+                    unsigned char neighbours =
+                        west[y - 1] + west[y] + west[y + 1] +
+                        centre[y - 1] + centre[y + 1] +
+                        east[y - 1] + east[y] + east[y + 1];
 
-    world.update();
+                    next[y] = this->rule.next(centre[y], neighbours);
+                }
+            }
 
-    if (!world.to_file("initial.txt"))
-    {
-        printf("failed to output initial state to file");
-        return 0;
+            this->tile_current.swap(this->tile_next);
+        }
+
+        for (size_t x = tile_x; x < core_x_end; ++x)
+        {
+            const unsigned char* local = this->tile_current.data() + (x - halo_x + 1) * padded + 1 - halo_y;
+            unsigned char* column = this->next_grid[x];
+
+            for (size_t y = tile_y; y < core_y_end; ++y)
+            {
+                column[y] = local[y];
+                this->next_population += local[y];
+            }
+        }
+    }
+
+    // dense engine for larger than life rules. every generation builds a
+    // summed area table of the board, after that the live cells in any
+    // neighbourhood are four lookups whatever the radius. the sums wrap
+    // around on huge boards but the difference for one neighbourhood is
+    // still exact as long as it fits
+    void tick_ltl(const LtlRule& rule)
+    {
+        size_t stride = this->y_size + 1;
+
+        this->area_sums.resize((this->x_size + 1) * stride);
+
+        // sums[x][y] holds the live cells left of x and above y
+        uint32_t* sums = this->area_sums.data();
+
+        std::fill(sums, sums + stride, 0);
+
+        for (size_t x = 0; x < this->x_size; ++x)
+        {
+            const unsigned char* column = this->grid[x];
+            const uint32_t* west = sums + x * stride;
+            uint32_t* current = sums + (x + 1) * stride;
+            uint32_t column_sum = 0;
+
+            current[0] = 0;
+
+            for (size_t y = 0; y < this->y_size; ++y)
+            {
+                column_sum += column[y] & CELL_ALIVE;
+                current[y + 1] = west[y + 1] + column_sum;
+            }
+        }
+
+        for (size_t x = 0; x < this->x_size; ++x)
+        {
+            size_t x_start = x < rule.radius ? 0 : x - rule.radius;
+            size_t x_end = std::min(x + rule.radius + 1, this->x_size);
+
+            const uint32_t* west = sums + x_start * stride;
+            const uint32_t* east = sums + x_end * stride;
+            const unsigned char* column = this->grid[x];
+            unsigned char* next = this->next_grid[x];
+
+            for (size_t y = 0; y < this->y_size; ++y)
+            {
+                size_t y_start = y < rule.radius ? 0 : y - rule.radius;
+                size_t y_end = std::min(y + rule.radius + 1, this->y_size);
+                bool alive = column[y] & CELL_ALIVE;
+
+                uint32_t neighbours = east[y_end] - east[y_start] - west[y_end] + west[y_start];
+
+                if (alive && !rule.middle)
+                {
+                    neighbours -= 1;
+                }
+
+                next[y] = rule.next(alive, neighbours);
+                this->next_population += next[y];
+            }
+        }
+    }
+
+    // dense engine that writes the next generation over grid instead of into
+    // next_grid, so next_grid is never touched and takes no memory. the old
+    // state that is still needed lives in three rolling columns: the column
+    // being written, the one before it that was already overwritten and the
+    // one after it. the alive lists are not kept either, a crowded board
+    // would need far more memory for them than for the board itself. takes
+    // the place of both tick() and update()
+    void tick_in_place()
+    {
+        size_t padded = this->y_size + 2;
+
+        this->rolling_columns.resize(3 * padded);
+
+        unsigned char* west = this->rolling_columns.data();
+        unsigned char* centre = west + padded;
+        unsigned char* east = centre + padded;
+        size_t population = 0;
+
+        std::fill(west, west + padded, 0);
+        std::fill(centre, centre + padded, 0);
+        std::fill(east, east + padded, 0);
+
+        this->load_column(0, centre);
+
+        for (size_t x = 0; x < this->x_size; ++x)
+        {
+            // the next column is still untouched, keep it before it is
+            // overwritten on the next pass
+            if (x + 1 < this->x_size)
+            {
+                this->load_column(x + 1, east);
+            }
+            else
+            {
+                std::fill(east, east + padded, 0);
+            }
+
+            unsigned char* column = this->grid[x];
+
+            for (size_t y = 1; y <= this->y_size; ++y)
+            {
+                unsigned char neighbours =
+                    west[y - 1] + west[y] + west[y + 1] +
+                    centre[y - 1] + centre[y + 1] +
+                    east[y - 1] + east[y] + east[y + 1];
+                unsigned char next = this->rule.next(centre[y], neighbours);
+
+                column[y - 1] = next;
+                population += next;
+            }
+
+            std::swap(west, centre);
+            std::swap(centre, east);
+        }
+
+        this->release_alive();
+        this->population = population;
+        this->history.record(population);
+    }
+
+    void load_column(size_t x, unsigned char* rolling)
+    {
+        const unsigned char* column = this->grid[x];
+
+        for (size_t y = 0; y < this->y_size; ++y)
+        {
+            rolling[y + 1] = column[y] & CELL_ALIVE;
+        }
+    }
+
+    void set_block(size_t x, size_t y, unsigned char result)
+    {
+        // drop the cells of the block that fall past the edge of a board
+        // with an odd size
+        if (x + 1 == this->x_size)
+        {
+            result &= 0b0011;
+        }
+
+        if (y + 1 == this->y_size)
+        {
+            result &= 0b0101;
+        }
+
+        unsigned char* left = this->next_grid[x];
+
+        left[y] = result & 1;
+        this->next_population += __builtin_popcount(result);
+
+        if (y + 1 < this->y_size)
+        {
+            left[y + 1] = (result >> 1) & 1;
+        }
+
+        if (x + 1 < this->x_size)
+        {
+            unsigned char* right = this->next_grid[x + 1];
+
+            right[y] = (result >> 2) & 1;
+
+            if (y + 1 < this->y_size)
+            {
+                right[y + 1] = (result >> 3) & 1;
+            }
+        }
+    }
+
+    // the grid that becomes next_grid was written while previous_alive was
+    // alive and produced the current alive list. only the neighbourhoods of
+    // the first and the cells of the second can be set so those are cleared
+    // instead of the whole board, leaving untouched pages alone
+    void clear_next_grid()
+    {
+        // for crowded boards clearing everything is cheaper
+        if (this->previous_alive.size() * 9 >= this->x_size * this->y_size)
+        {
+            this->next_grid.clear();
+            return;
+        }
+
+        for (Coord& cell : this->previous_alive)
+        {
+            size_t x_start = cell.x == 0 ? 0 : cell.west();
+            size_t x_end = cell.x == this->x_max ? cell.x : cell.east();
+            size_t y_start = cell.y == 0 ? 0 : cell.north();
+            size_t y_end = cell.y == this->y_max ? cell.y : cell.south();
+
+            for (size_t x = x_start; x <= x_end; ++x)
+            {
+                std::fill(this->next_grid[x] + y_start, this->next_grid[x] + y_end + 1, 0);
+            }
+        }
+
+        for (Coord& cell : this->alive)
+        {
+            this->next_grid[cell.x][cell.y] = 0;
+        }
+    }
+
+    void update()
+    {
+        this->grid.swap(this->next_grid);
+        this->clear_next_grid();
+
+        this->previous_alive.swap(this->alive);
+        this->alive.swap(this->next_alive);
+        this->next_alive.clear();
+
+        this->population = this->alive.size();
+        this->history.record(this->population);
+        this->next_alive.reserve(this->history.predict());
+    }
+
+    // puts a live cell on the board before the first generation. only the
+    // sparse engine reads the alive list, the dense engines start from grid
+    // and would just have to free the list again
+    void place(Coord& cell, bool track_alive)
+    {
+        if (track_alive)
+        {
+            this->spawn(cell);
+        }
+        else if (!(this->grid[cell.x][cell.y] & CELL_ALIVE))
+        {
+            this->grid[cell.x][cell.y] = CELL_ALIVE;
+            this->population += 1;
+        }
+    }
+
+    void finish_placing(bool track_alive)
+    {
+        if (track_alive)
+        {
+            this->update();
+        }
+    }
+
+    // dense engines write every cell of next_grid so there is nothing to
+    // clear, and they count the population instead of keeping alive lists
+    void update_dense()
+    {
+        this->grid.swap(this->next_grid);
+
+        this->population = this->next_population;
+        this->next_population = 0;
+        this->history.record(this->population);
+
+        this->release_alive();
+    }
+
+    // frees the alive lists left over from loading the world, they would
+    // take far more memory than the board on a crowded one
+    void release_alive()
+    {
+        if (this->previous_alive.capacity() + this->alive.capacity() + this->next_alive.capacity() == 0)
+        {
+            return;
+        }
+
+        std::vector<Coord>().swap(this->previous_alive);
+        std::vector<Coord>().swap(this->alive);
+        std::vector<Coord>().swap(this->next_alive);
+    }
+
+    bool to_file(std::string file_name)
+    {
+        std::ofstream file(file_name);
+
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        for (size_t y_index = 0; y_index < this->y_size; ++y_index)
+        {
+            for (size_t x_index = 0; x_index < this->x_size; ++x_index)
+            {
+                if (this->grid[x_index][y_index] & CELL_ALIVE)
+                {
+                    file << '1';
+                }
+                else
+                {
+                    file << ' ';
+                }
+            }
+
+            file << '\n';
+        }
+
+        file.close();
+
+        return true;
+    }
+
+    // bit packed copy of the grid, one bit per cell in the same column order
+    void pack(std::vector<unsigned char>& packed)
+    {
+        packed.resize((this->grid.bytes + 7) / 8);
+
+        for (size_t byte = 0; byte < packed.size(); ++byte)
+        {
+            size_t first = byte * 8;
+            size_t count = std::min<size_t>(8, this->grid.bytes - first);
+            unsigned char bits = 0;
+
+            for (size_t bit = 0; bit < count; ++bit)
+            {
+                bits |= (this->grid.cells[first + bit] & CELL_ALIVE) << bit;
+            }
+
+            packed[byte] = bits;
+        }
+    }
+};
+
+bool write_all(int file, const char* data, size_t size)
+{
+    while (size != 0)
+    {
+        ssize_t written = write(file, data, size);
+
+        if (written == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return false;
+        }
+
+        data += written;
+        size -= written;
+    }
+
+    return true;
+}
+
+enum class SnapshotState {
+    Free,
+    Ready
+};
+
+struct Snapshot
+{
+    // text is written out in pieces of this size so a snapshot never holds
+    // a whole text board
+    static constexpr size_t TEXT_CHUNK = 1 << 16;
+
+    SnapshotState state = SnapshotState::Free;
+    size_t generation = 0;
+
+    // bit packed copy of the world grid, see World::pack
+    std::vector<unsigned char> packed;
+    std::string text;
+
+    bool to_file(size_t x_size, size_t y_size)
+    {
+        char file_name[64];
+
+        snprintf(file_name, sizeof(file_name), "generation_%zu.txt", this->generation);
+
+        int file = open(file_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+        if (file == -1)
+        {
+            return false;
+        }
+
+        this->text.reserve(TEXT_CHUNK);
+        this->text.clear();
+
+        for (size_t y_index = 0; y_index < y_size; ++y_index)
+        {
+            for (size_t x_index = 0; x_index <= x_size; ++x_index)
+            {
+                if (this->text.size() == TEXT_CHUNK)
+                {
+                    if (!write_all(file, this->text.data(), this->text.size()))
+                    {
+                        close(file);
+                        return false;
+                    }
+
+                    this->text.clear();
+                }
+
+                if (x_index == x_size)
+                {
+                    this->text.push_back('\n');
+                    continue;
+                }
+
+                size_t cell = x_index * y_size + y_index;
+
+                if ((this->packed[cell / 8] >> (cell % 8)) & 1)
+                {
+                    this->text.push_back('1');
+                }
+                else
+                {
+                    this->text.push_back(' ');
+                }
+            }
+        }
+
+        bool written = write_all(file, this->text.data(), this->text.size());
+
+        close(file);
+
+        return written;
+    }
+};
+
+// a run history stored in a single file. every generation is bit packed,
+// one bit per cell in the same column order as World::grid. keyframes store
+// the packed generation, the frames in between store it XORed with the
+// previous generation. both are run length encoded as pairs of
+// (zero bytes, literal bytes) counts followed by the literal bytes.
+//
+// header   "GOLH" | u32 version | u64 x_size | u64 y_size | u64 keyframe interval
+// frame    u8 kind | u64 payload size | payload
+// index    u64 frame count | u64 frame offset ...
+// footer   u64 index offset | "GOLX"
+//
+// numbers are stored in host byte order, counts inside a payload as varints
+const char HISTORY_MAGIC[4] = {'G', 'O', 'L', 'H'};
+const char HISTORY_FOOTER_MAGIC[4] = {'G', 'O', 'L', 'X'};
+const uint32_t HISTORY_VERSION = 1;
+const size_t HISTORY_HEADER_SIZE = 4 + 4 + 8 * 3;
+const size_t HISTORY_FOOTER_SIZE = 8 + 4;
+const size_t FRAME_HEADER_SIZE = 1 + 8;
+
+enum class FrameKind : unsigned char {
+    Keyframe = 0,
+    Delta = 1
+};
+
+void write_varint(std::vector<unsigned char>& output, size_t value)
+{
+    while (value >= 0x80)
+    {
+        output.push_back((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+
+    output.push_back(value);
+}
+
+bool read_varint(const std::vector<unsigned char>& input, size_t& position, size_t& value)
+{
+    value = 0;
+
+    for (size_t shift = 0; shift < 64; shift += 7)
+    {
+        if (position >= input.size())
+        {
+            return false;
+        }
+
+        unsigned char byte = input[position++];
+
+        value |= (size_t)(byte & 0x7f) << shift;
+
+        if (!(byte & 0x80))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void rle_encode(const std::vector<unsigned char>& input, std::vector<unsigned char>& output)
+{
+    size_t position = 0;
+
+    output.clear();
+
+    while (position < input.size())
+    {
+        size_t zeros = 0;
+
+        while (position + zeros < input.size() && input[position + zeros] == 0)
+        {
+            zeros += 1;
+        }
+
+        position += zeros;
+
+        size_t literals = 0;
+
+        while (position + literals < input.size() && input[position + literals] != 0)
+        {
+            literals += 1;
+        }
+
+        write_varint(output, zeros);
+        write_varint(output, literals);
+        output.insert(output.end(), input.begin() + position, input.begin() + position + literals);
+
+        position += literals;
+    }
+}
+
+// the amount of bytes the encoded data unpacks to
+bool rle_decoded_size(const std::vector<unsigned char>& input, size_t& size)
+{
+    size_t read = 0;
+
+    size = 0;
+
+    while (read < input.size())
+    {
+        size_t zeros = 0;
+        size_t literals = 0;
+
+        if (!read_varint(input, read, zeros) || !read_varint(input, read, literals))
+        {
+            return false;
+        }
+
+        if (literals > input.size() - read || zeros > SIZE_MAX - size - literals)
+        {
+            return false;
+        }
+
+        size += zeros + literals;
+        read += literals;
+    }
+
+    return true;
+}
+
+// XORs the decoded bytes into output, which must already have the unpacked size
+bool rle_decode_xor(const std::vector<unsigned char>& input, std::vector<unsigned char>& output)
+{
+    size_t read = 0;
+    size_t position = 0;
+
+    while (read < input.size())
+    {
+        size_t zeros = 0;
+        size_t literals = 0;
+
+        if (!read_varint(input, read, zeros) || !read_varint(input, read, literals))
+        {
+            return false;
+        }
+
+        // compared by subtraction so huge counts can not wrap around
+        if (zeros > output.size() - position)
+        {
+            return false;
+        }
+
+        position += zeros;
+
+        if (literals > output.size() - position || literals > input.size() - read)
+        {
+            return false;
+        }
+
+        for (size_t index = 0; index < literals; ++index)
+        {
+            output[position + index] ^= input[read + index];
+        }
+
+        position += literals;
+        read += literals;
+    }
+
+    return true;
+}
+
+struct HistoryWriter
+{
+    static constexpr size_t KEYFRAME_INTERVAL = 64;
+
+    size_t x_size = 0;
+    size_t y_size = 0;
+
+    std::ofstream file;
+    uint64_t offset = 0;
+    std::vector<uint64_t> index;
+
+    // last generation appended, sized on the first append
+    std::vector<unsigned char> previous;
+    std::vector<unsigned char> encoded;
+
+    // the index grows as frames are written, the generation count comes
+    // straight from the command line and can not be trusted to size it
+    HistoryWriter(size_t x_size, size_t y_size) :
+        x_size(x_size), y_size(y_size)
+    {
+    }
+
+    bool open(const std::string& file_name)
+    {
+        this->file.open(file_name, std::ios::binary | std::ios::trunc);
+
+        if (!this->file.is_open())
+        {
+            return false;
+        }
+
+        uint64_t header[3] = {this->x_size, this->y_size, KEYFRAME_INTERVAL};
+
+        this->file.write(HISTORY_MAGIC, sizeof(HISTORY_MAGIC));
+        this->file.write((const char*)&HISTORY_VERSION, sizeof(HISTORY_VERSION));
+        this->file.write((const char*)header, sizeof(header));
+        this->offset = HISTORY_HEADER_SIZE;
+
+        return this->file.good();
+    }
+
+    // generations must be appended in order starting from zero, packed by
+    // World::pack
+    bool append(const std::vector<unsigned char>& packed)
+    {
+        FrameKind kind = this->index.size() % KEYFRAME_INTERVAL == 0 ?
+            FrameKind::Keyframe :
+            FrameKind::Delta;
+
+        if (kind == FrameKind::Delta)
+        {
+            // previous becomes the difference and is replaced below anyway
+            for (size_t byte = 0; byte < packed.size(); ++byte)
+            {
+                this->previous[byte] ^= packed[byte];
+            }
+
+            rle_encode(this->previous, this->encoded);
+        }
+        else
+        {
+            rle_encode(packed, this->encoded);
+        }
+
+        this->previous.assign(packed.begin(), packed.end());
+
+        uint64_t size = this->encoded.size();
+
+        this->file.put((char)kind);
+        this->file.write((const char*)&size, sizeof(size));
+        this->file.write((const char*)this->encoded.data(), this->encoded.size());
+
+        this->index.push_back(this->offset);
+        this->offset += FRAME_HEADER_SIZE + size;
+
+        return this->file.good();
+    }
+
+    bool finish()
+    {
+        uint64_t count = this->index.size();
+        uint64_t index_offset = this->offset;
+
+        this->file.write((const char*)&count, sizeof(count));
+        this->file.write((const char*)this->index.data(), this->index.size() * sizeof(uint64_t));
+        this->file.write((const char*)&index_offset, sizeof(index_offset));
+        this->file.write(HISTORY_FOOTER_MAGIC, sizeof(HISTORY_FOOTER_MAGIC));
+        this->file.close();
+
+        return !this->file.fail();
+    }
+};
+
+struct HistoryReader
+{
+    size_t x_size = 0;
+    size_t y_size = 0;
+    size_t keyframe_interval = 0;
+
+    std::ifstream file;
+    std::vector<uint64_t> index;
+
+    // packed state of the last generation read, used to continue a range
+    // without going back to the keyframe
+    std::vector<unsigned char> packed;
+    size_t current = 0;
+    bool has_current = false;
+
+    std::vector<unsigned char> encoded;
+
+    // frames end where the index starts
+    uint64_t frames_end = 0;
+
+    bool open(const std::string& file_name, std::string& error)
+    {
+        this->file.open(file_name, std::ios::binary);
+
+        if (!this->file.is_open())
+        {
+            error = "failed to open history archive \"" + file_name + "\"";
+            return false;
+        }
+
+        // everything read from here on is checked against the file length
+        // before it is used to size anything
+        error = "corrupt archive \"" + file_name + "\"";
+
+        this->file.seekg(0, std::ios::end);
+
+        uint64_t length = this->file.tellg();
+
+        if (!this->file || length < HISTORY_HEADER_SIZE + HISTORY_FOOTER_SIZE + sizeof(uint64_t))
+        {
+            return false;
+        }
+
+        char magic[4];
+        uint32_t version = 0;
+        uint64_t header[3];
+
+        this->file.seekg(0);
+        this->file.read(magic, sizeof(magic));
+        this->file.read((char*)&version, sizeof(version));
+        this->file.read((char*)header, sizeof(header));
+
+        if (!this->file || !std::equal(magic, magic + 4, HISTORY_MAGIC) || version != HISTORY_VERSION)
+        {
+            return false;
+        }
+
+        this->x_size = header[0];
+        this->y_size = header[1];
+        this->keyframe_interval = header[2];
+
+        if (this->x_size == 0 || this->y_size == 0 || this->keyframe_interval == 0)
+        {
+            return false;
+        }
+
+        if (this->x_size > SIZE_MAX / this->y_size)
+        {
+            return false;
+        }
+
+        uint64_t index_offset = 0;
+        uint64_t count = 0;
+
+        this->file.seekg(length - HISTORY_FOOTER_SIZE);
+        this->file.read((char*)&index_offset, sizeof(index_offset));
+        this->file.read(magic, sizeof(magic));
+
+        if (!this->file || !std::equal(magic, magic + 4, HISTORY_FOOTER_MAGIC))
+        {
+            return false;
+        }
+
+        if (index_offset < HISTORY_HEADER_SIZE || index_offset > length - HISTORY_FOOTER_SIZE - sizeof(count))
+        {
+            return false;
+        }
+
+        this->file.seekg(index_offset);
+        this->file.read((char*)&count, sizeof(count));
+
+        // the index has to fill the space up to the footer exactly
+        uint64_t index_bytes = length - HISTORY_FOOTER_SIZE - index_offset - sizeof(count);
+
+        if (!this->file || index_bytes % sizeof(uint64_t) != 0 || count != index_bytes / sizeof(uint64_t))
+        {
+            return false;
+        }
+
+        this->index.resize(count);
+        this->file.read((char*)this->index.data(), count * sizeof(uint64_t));
+
+        if (!this->file)
+        {
+            return false;
+        }
+
+        for (uint64_t offset : this->index)
+        {
+            if (offset < HISTORY_HEADER_SIZE || offset > index_offset - FRAME_HEADER_SIZE)
+            {
+                return false;
+            }
+        }
+
+        this->frames_end = index_offset;
+
+        // the first keyframe has to unpack to exactly one board, which keeps
+        // a damaged header from sizing the board
+        size_t board_bytes = 0;
+
+        if (count != 0)
+        {
+            if (!this->read_encoded(0) || !rle_decoded_size(this->encoded, board_bytes))
+            {
+                return false;
+            }
+
+            if (board_bytes != (this->x_size * this->y_size + 7) / 8)
+            {
+                return false;
+            }
+        }
+
+        try
+        {
+            this->packed.resize((this->x_size * this->y_size + 7) / 8);
+        }
+        catch (const std::exception&)
+        {
+            error = "board in archive \"" + file_name + "\" is too large to read";
+            return false;
+        }
+
+        return true;
+    }
+
+    size_t generations()
+    {
+        return this->index.size();
+    }
+
+    // reads the payload of a frame into encoded along with its kind
+    bool read_encoded(size_t generation, unsigned char* frame_kind = nullptr)
+    {
+        unsigned char kind = 0;
+        uint64_t size = 0;
+
+        this->file.seekg(this->index[generation]);
+        this->file.read((char*)&kind, sizeof(kind));
+        this->file.read((char*)&size, sizeof(size));
+
+        if (!this->file || size > this->frames_end - this->index[generation] - FRAME_HEADER_SIZE)
+        {
+            return false;
+        }
+
+        this->encoded.resize(size);
+        this->file.read((char*)this->encoded.data(), size);
+
+        if (frame_kind != nullptr)
+        {
+            *frame_kind = kind;
+        }
+
+        return (bool)this->file;
+    }
+
+    bool read_frame(size_t generation)
+    {
+        unsigned char kind = 0;
+
+        if (!this->read_encoded(generation, &kind))
+        {
+            return false;
+        }
+
+        if (kind == (unsigned char)FrameKind::Keyframe)
+        {
+            std::fill(this->packed.begin(), this->packed.end(), 0);
+        }
+        else if (kind != (unsigned char)FrameKind::Delta)
+        {
+            return false;
+        }
+
+        return rle_decode_xor(this->encoded, this->packed);
+    }
+
+    bool read(size_t generation, std::vector<unsigned char>& packed)
+    {
+        if (generation >= this->index.size())
+        {
+            return false;
+        }
+
+        size_t keyframe = generation - generation % this->keyframe_interval;
+        size_t start = keyframe;
+
+        // keep going from the last generation when it is on the way
+        if (this->has_current && this->current >= keyframe && this->current <= generation)
+        {
+            start = this->current + 1;
+        }
+
+        this->has_current = false;
+
+        for (size_t frame = start; frame <= generation; ++frame)
+        {
+            if (!this->read_frame(frame))
+            {
+                return false;
+            }
+        }
+
+        this->current = generation;
+        this->has_current = true;
+
+        packed.assign(this->packed.begin(), this->packed.end());
+
+        return true;
+    }
+};
+
+// writes generations to disk on a separate thread so the next generation can
+// be computed while the previous one is serialised. snapshots are handed out
+// round robin so the writer always sees them in generation order.
+struct OutputPipeline
+{
+    static constexpr size_t BUFFER_COUNT = 3;
+
+    size_t x_size = 0;
+    size_t y_size = 0;
+
+    // when set generations are appended to the archive instead of being
+    // written to their own files
+    HistoryWriter* archive = nullptr;
+
+    Snapshot buffers[BUFFER_COUNT];
+    size_t fill_index = 0;
+    size_t write_index = 0;
+    bool finished = false;
+
+    std::mutex lock;
+    std::condition_variable changed;
+    std::thread writer;
+
+    OutputPipeline(size_t x_size, size_t y_size, HistoryWriter* archive) :
+        x_size(x_size), y_size(y_size), archive(archive)
+    {
+        this->writer = std::thread(&OutputPipeline::run, this);
+    }
+
+    ~OutputPipeline()
+    {
+        this->finish();
+    }
+
+    void push(World& world, size_t generation)
+    {
+        Snapshot& snapshot = this->buffers[this->fill_index];
+
+        {
+            std::unique_lock<std::mutex> guard(this->lock);
+
+            this->changed.wait(guard, [&snapshot] {
+                return snapshot.state == SnapshotState::Free;
+            });
+        }
+
+        // the writer will not touch a free snapshot so it can be filled
+        // without holding the lock
+        world.pack(snapshot.packed);
+        snapshot.generation = generation;
+
+        {
+            std::lock_guard<std::mutex> guard(this->lock);
+
+            snapshot.state = SnapshotState::Ready;
+        }
+
+        this->changed.notify_all();
+        this->fill_index = (this->fill_index + 1) % BUFFER_COUNT;
+    }
+
+    void finish()
+    {
+        if (!this->writer.joinable())
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(this->lock);
+
+            this->finished = true;
+        }
+
+        this->changed.notify_all();
+        this->writer.join();
+    }
+
+    void run()
+    {
+        while (true)
+        {
+            Snapshot& snapshot = this->buffers[this->write_index];
+
+            {
+                std::unique_lock<std::mutex> guard(this->lock);
+
+                this->changed.wait(guard, [this, &snapshot] {
+                    return snapshot.state == SnapshotState::Ready || this->finished;
+                });
+
+                if (snapshot.state != SnapshotState::Ready)
+                {
+                    return;
+                }
+            }
+
+            bool written = this->archive ?
+                this->archive->append(snapshot.packed) :
+                snapshot.to_file(this->x_size, this->y_size);
+
+            if (!written)
+            {
+                printf("failed to output generation %zu to file\n", snapshot.generation);
+            }
+
+            {
+                std::lock_guard<std::mutex> guard(this->lock);
+
+                snapshot.state = SnapshotState::Free;
+            }
+
+            this->changed.notify_all();
+            this->write_index = (this->write_index + 1) % BUFFER_COUNT;
+        }
+    }
+};
+
+enum class Engine {
+    Sparse,
+    Lookup,
+    Temporal,
+    LargerThanLife,
+    InPlace
+};
+
+std::optional<Engine> parse_engine(const std::string& name)
+{
+    if (name == "sparse")
+    {
+        return Engine::Sparse;
+    }
+    else if (name == "lookup")
+    {
+        return Engine::Lookup;
+    }
+    else if (name == "temporal")
+    {
+        return Engine::Temporal;
+    }
+    else if (name == "ltl")
+    {
+        return Engine::LargerThanLife;
+    }
+    else if (name == "inplace")
+    {
+        return Engine::InPlace;
+    }
+
+    return std::nullopt;
+}
+
+struct EngineSettings
+{
+    Engine engine = Engine::Sparse;
+
+    // generations and tile size of the temporal engine
+    size_t depth = 4;
+    size_t tile_size = 128;
+
+    // rule of the larger than life engine
+    LtlRule ltl_rule;
+
+    // only the sparse engine works from the alive lists
+    bool track_alive() const
+    {
+        return this->engine == Engine::Sparse;
+    }
+};
+
+// advances the world by the given amount of generations. only the temporal
+// engine steps more than one generation per call
+void advance(World& world, const EngineSettings& settings, const LookupTable& table, size_t generations)
+{
+    while (generations != 0)
+    {
+        size_t steps = 1;
+
+        switch (settings.engine)
+        {
+            case Engine::Sparse:
+                world.tick();
+                break;
+            case Engine::Lookup:
+                world.tick_lookup(table);
+                break;
+            case Engine::Temporal:
+                steps = std::min(settings.depth, generations);
+                world.tick_temporal(steps, settings.tile_size);
+                break;
+            case Engine::LargerThanLife:
+                world.tick_ltl(settings.ltl_rule);
+                break;
+            case Engine::InPlace:
+                world.tick_in_place();
+                break;
+        }
+
+        switch (settings.engine)
+        {
+            case Engine::Sparse:
+                world.update();
+                break;
+            case Engine::Lookup:
+            case Engine::Temporal:
+            case Engine::LargerThanLife:
+                world.update_dense();
+                break;
+            case Engine::InPlace:
+                break;
+        }
+
+        generations -= steps;
+    }
+}
+
+// reads a start file, the grid size on the first line followed by the
+// coordinates of the live cells, one per line
+std::unique_ptr<World> load_world(const std::string& file_name, bool track_alive, std::string& error)
+{
+    std::ifstream input_file(file_name);
+
+    if (!input_file.is_open())
+    {
+        error = "failed to open start file \"" + file_name + "\"";
+        return nullptr;
+    }
+
+    std::string line;
+    size_t x_size = 0;
+    size_t y_size = 0;
+
+    // get the grid size
+    if (std::getline(input_file, line))
+    {
+        if (2 != sscanf(line.c_str(), "%zu:%zu", &x_size, &y_size))
+        {
+            error = "invalid grid size of first line of file";
+            return nullptr;
+        }
+
+        if (x_size < 3 || y_size < 3)
+        {
+            error = "grid size is too small. x and y must be greater than 3";
+            return nullptr;
+        }
+    }
+    else
+    {
+        error = "failed to read first line of file";
+        return nullptr;
+    }
+
+    std::unique_ptr<World> world;
+
+    // the grids are mapped up front, a board too large for the address
+    // space is reported instead of taking down the server
+    try
+    {
+        world.reset(new World(x_size, y_size));
+    }
+    catch (const std::bad_alloc&)
+    {
+        error = "board too large";
+        return nullptr;
+    }
+
+    Coord pos(0, 0);
+
+    while (std::getline(input_file, line))
+    {
+        if (2 != sscanf(line.c_str(), "%zu,%zu", &pos.x, &pos.y))
+        {
+            error = "failed to parse coordinate " + line;
+            return nullptr;
+        }
+
+        if (pos.x >= x_size || pos.y >= y_size)
+        {
+            error = "coordinate outside of the grid " + line;
+            return nullptr;
+        }
+
+        world->place(pos, track_alive);
+    }
+
+    world->finish_placing(track_alive);
+
+    return world;
+}
+
+struct RunMetrics
+{
+    size_t generations = 0;
+    size_t allocations = 0;
+    size_t allocating_generations = 0;
+    size_t last_allocating_generation = 0;
+    std::chrono::steady_clock::duration compute_time{};
+
+    void record_generation(size_t generation, size_t steps, size_t allocations, std::chrono::steady_clock::duration elapsed)
+    {
+        this->compute_time += elapsed;
+        this->generations += steps;
+        this->allocations += allocations;
+
+        if (allocations != 0)
+        {
+            this->allocating_generations += 1;
+            this->last_allocating_generation = generation;
+        }
+    }
+
+    void print()
+    {
+        printf("---------- metrics\n");
+        printf("generations: %zu\n", this->generations);
+        printf("heap allocations: %zu\n", this->allocations);
+        printf("generations that allocated: %zu\n", this->allocating_generations);
+        printf("last generation that allocated: %zu\n", this->last_allocating_generation);
+        printf(
+            "compute time: %.3f ms\n",
+            std::chrono::duration<double, std::milli>(this->compute_time).count()
+        );
+    }
+};
+
+// writes the generations between the given numbers from a history archive
+// to their own files
+int extract_history(const std::string& file_name, std::vector<char*>& positional)
+{
+    HistoryReader reader;
+    size_t first = 0;
+    size_t last = 0;
+
+    std::string error;
+
+    if (!reader.open(file_name, error))
+    {
+        printf("%s\n", error.c_str());
+        return 0;
+    }
+
+    if (reader.generations() == 0)
+    {
+        printf("archive contains no generations\n");
+        return 0;
+    }
+
+    if (positional.size() < 1)
+    {
+        printf("provide the generation to extract\n");
+        return 0;
+    }
+
+    if (1 != sscanf(positional[0], "%zu", &first))
+    {
+        printf("failed to parse generation \"%s\"\n", positional[0]);
+        return 0;
+    }
+
+    last = first;
+
+    if (positional.size() == 2)
+    {
+        if (1 != sscanf(positional[1], "%zu", &last))
+        {
+            printf("failed to parse generation \"%s\"\n", positional[1]);
+            return 0;
+        }
+    }
+
+    if (last < first || last >= reader.generations())
+    {
+        printf("archive contains generations 0 to %zu\n", reader.generations() - 1);
+        return 0;
+    }
+
+    Snapshot snapshot;
+
+    for (size_t generation = first; generation <= last; ++generation)
+    {
+        if (!reader.read(generation, snapshot.packed))
+        {
+            printf("failed to read generation %zu, corrupt archive\n", generation);
+            return 0;
+        }
+
+        snapshot.generation = generation;
+
+        if (!snapshot.to_file(reader.x_size, reader.y_size))
+        {
+            printf("failed to output generation %zu to file\n", generation);
+            return 0;
+        }
+    }
+
+    printf("extracted generations %zu to %zu\n", first, last);
+
+    return 0;
+}
+
+// a world kept in memory by the server along with the pattern it was loaded
+// from so it can be reset
+struct ServedWorld
+{
+    std::mutex lock;
+    std::unique_ptr<World> world;
+    size_t generation = 0;
+
+    // the loaded board, bit packed by World::pack
+    std::vector<unsigned char> initial;
+    bool track_alive = true;
+
+    void reset()
+    {
+        size_t x_size = this->world->x_size;
+        size_t y_size = this->world->y_size;
+
+        this->world.reset(new World(x_size, y_size));
+
+        for (size_t cell = 0; cell < x_size * y_size; ++cell)
+        {
+            if ((this->initial[cell / 8] >> (cell % 8)) & 1)
+            {
+                Coord pos(cell / y_size, cell % y_size);
+
+                this->world->place(pos, this->track_alive);
+            }
+        }
+
+        this->world->finish_placing(this->track_alive);
+        this->generation = 0;
+    }
+};
+
+// keeps worlds in memory and answers commands from clients connected to a
+// unix socket, one thread per client. requests and responses are single
+// lines, responses start with OK or ERR:
+//
+// LOAD name path            OK x_size y_size
+// STEP name generations     OK generation
+// POPULATION name           OK population
+// REGION name x y w h       OK w h, followed by h lines of 1 and .
+// SNAPSHOT name path        OK
+// RESET name                OK
+// QUIT
+//
+// STEP takes at most MAX_STEP generations at once
+struct Server
+{
+    // generations a single STEP may ask for, so one client can not hold a
+    // world for too long
+    static constexpr size_t MAX_STEP = 1000000;
+
+    EngineSettings settings;
+    LookupTable table;
+
+    std::mutex worlds_lock;
+    std::map<std::string, std::shared_ptr<ServedWorld>> worlds;
+
+    Server(const EngineSettings& settings) :
+        settings(settings), table(Rule())
+    {}
+
+    std::shared_ptr<ServedWorld> find(const std::string& name)
+    {
+        std::lock_guard<std::mutex> guard(this->worlds_lock);
+
+        auto found = this->worlds.find(name);
+
+        if (found == this->worlds.end())
+        {
+            return nullptr;
+        }
+
+        return found->second;
+    }
+
+    std::string command(const std::string& line, bool& quit)
+    {
+        std::istringstream input(line);
+        std::string name;
+        std::string verb;
+
+        input >> verb;
+
+        if (verb == "QUIT")
+        {
+            quit = true;
+            return "OK\n";
+        }
+
+        if (!(input >> name))
+        {
+            return "ERR missing world name\n";
+        }
+
+        if (verb == "LOAD")
+        {
+            std::string path;
+
+            if (!(input >> path))
+            {
+                return "ERR missing start file\n";
+            }
+
+            std::string error;
+            std::shared_ptr<ServedWorld> served(new ServedWorld());
+
+            served->track_alive = this->settings.track_alive();
+            served->world = load_world(path, served->track_alive, error);
+
+            if (!served->world)
+            {
+                return "ERR " + error + "\n";
+            }
+
+            served->world->pack(served->initial);
+
+            std::string response = "OK " +
+                std::to_string(served->world->x_size) + " " +
+                std::to_string(served->world->y_size) + "\n";
+
+            std::lock_guard<std::mutex> guard(this->worlds_lock);
+
+            this->worlds[name] = served;
+
+            return response;
+        }
+
+        std::shared_ptr<ServedWorld> served = this->find(name);
+
+        if (!served)
+        {
+            return "ERR unknown world " + name + "\n";
+        }
+
+        std::lock_guard<std::mutex> guard(served->lock);
+        World& world = *served->world;
+
+        if (verb == "STEP")
+        {
+            std::string count;
+
+            if (!(input >> count))
+            {
+                return "ERR missing generations\n";
+            }
+
+            // read as digits only, >> into a size_t would take -1 as the
+            // largest value and hold the world forever
+            if (count.size() > 7 || count.find_first_not_of("0123456789") != std::string::npos)
+            {
+                return "ERR generations must be a number up to " + std::to_string(MAX_STEP) + "\n";
+            }
+
+            size_t generations = std::stoul(count);
+
+            if (generations > MAX_STEP)
+            {
+                return "ERR generations must be a number up to " + std::to_string(MAX_STEP) + "\n";
+            }
+
+            advance(world, this->settings, this->table, generations);
+            served->generation += generations;
+
+            return "OK " + std::to_string(served->generation) + "\n";
+        }
+        else if (verb == "POPULATION")
+        {
+            return "OK " + std::to_string(world.population) + "\n";
+        }
+        else if (verb == "REGION")
+        {
+            size_t x = 0;
+            size_t y = 0;
+            size_t width = 0;
+            size_t height = 0;
+
+            if (!(input >> x >> y >> width >> height))
+            {
+                return "ERR expected x y width height\n";
+            }
+
+            if (x >= world.x_size || y >= world.y_size)
+            {
+                return "ERR region outside of the grid\n";
+            }
+
+            width = std::min(width, world.x_size - x);
+            height = std::min(height, world.y_size - y);
+
+            std::string response = "OK " + std::to_string(width) + " " + std::to_string(height) + "\n";
+
+            for (size_t row = y; row < y + height; ++row)
+            {
+                for (size_t col = x; col < x + width; ++col)
+                {
+                    response.push_back(world.grid[col][row] & CELL_ALIVE ? '1' : '.');
+                }
+
+                response.push_back('\n');
+            }
+
+            return response;
+        }
+        else if (verb == "SNAPSHOT")
+        {
+            std::string path;
+
+            if (!(input >> path))
+            {
+                return "ERR missing output file\n";
+            }
+
+            if (!world.to_file(path))
+            {
+                return "ERR failed to write " + path + "\n";
+            }
+
+            return "OK\n";
+        }
+        else if (verb == "RESET")
+        {
+            served->reset();
+
+            return "OK\n";
+        }
+
+        return "ERR unknown command " + verb + "\n";
+    }
+
+    void client(int connection)
+    {
+        std::string pending;
+        char buffer[4096];
+        bool quit = false;
+
+        while (!quit)
+        {
+            ssize_t received = recv(connection, buffer, sizeof(buffer), 0);
+
+            if (received <= 0)
+            {
+                if (received == -1 && errno == EINTR)
+                {
+                    continue;
+                }
+
+                break;
+            }
+
+            pending.append(buffer, received);
+
+            size_t line_end = 0;
+
+            while (!quit && (line_end = pending.find('\n')) != std::string::npos)
+            {
+                std::string response = this->command(pending.substr(0, line_end), quit);
+
+                pending.erase(0, line_end + 1);
+
+                if (!send_all(connection, response))
+                {
+                    quit = true;
+                }
+            }
+        }
+
+        close(connection);
+    }
+
+    static bool send_all(int connection, const std::string& data)
+    {
+        size_t sent = 0;
+
+        while (sent < data.size())
+        {
+            ssize_t written = send(connection, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+
+            if (written == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                return false;
+            }
+
+            sent += written;
+        }
+
+        return true;
+    }
+};
+
+int serve(const std::string& path, const EngineSettings& settings)
+{
+    // worlds are stepped for clients, the per cell output would interleave
+    trace_enabled = false;
+
+    sockaddr_un address{};
+
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        printf("socket path \"%s\" is too long\n", path.c_str());
+        return 0;
+    }
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (listener == -1)
+    {
+        printf("failed to create socket\n");
+        return 0;
+    }
+
+    address.sun_family = AF_UNIX;
+    std::copy(path.begin(), path.end(), address.sun_path);
+
+    // only a stale socket from an earlier run is removed, anything else
+    // at the path is left alone
+    struct stat existing;
+
+    if (lstat(path.c_str(), &existing) == 0)
+    {
+        if (!S_ISSOCK(existing.st_mode))
+        {
+            printf("\"%s\" exists and is not a socket\n", path.c_str());
+            close(listener);
+            return 0;
+        }
+
+        unlink(path.c_str());
+    }
+
+    if (bind(listener, (sockaddr*)&address, sizeof(address)) == -1 || listen(listener, 64) == -1)
+    {
+        printf("failed to listen on \"%s\"\n", path.c_str());
+        close(listener);
+        return 0;
+    }
+
+    // client threads are detached and keep using the server, so it lives
+    // until the process exits instead of on this stack frame
+    Server* server = new Server(settings);
+
+    printf("listening on %s\n", path.c_str());
+    fflush(stdout);
+
+    while (true)
+    {
+        int connection = accept(listener, nullptr, nullptr);
+
+        if (connection == -1)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+
+            printf("failed to accept connection\n");
+            break;
+        }
+
+        std::thread(&Server::client, server, connection).detach();
+    }
+
+    close(listener);
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    size_t generations = 2;
+    EngineSettings settings;
+    std::string archive_file;
+    std::string serve_path;
+    std::string extract_file;
+    bool has_rule = false;
+    bool write_output = true;
+    std::vector<char*> positional;
+
+    for (int index = 1; index < argc; ++index)
+    {
+        std::string arg(argv[index]);
+
+        if (arg == "--quiet")
+        {
+            trace_enabled = false;
+        }
+        else if (arg == "--no-output")
+        {
+            write_output = false;
+        }
+        else if (arg.rfind("--engine=", 0) == 0)
+        {
+            std::optional<Engine> parsed = parse_engine(arg.substr(9));
+
+            if (!parsed)
+            {
+                printf("unknown engine \"%s\"\n", arg.c_str() + 9);
+                return 0;
+            }
+
+            settings.engine = *parsed;
+        }
+        else if (arg.rfind("--depth=", 0) == 0)
+        {
+            if (1 != sscanf(arg.c_str() + 8, "%zu", &settings.depth) || settings.depth == 0)
+            {
+                printf("invalid temporal depth \"%s\"\n", arg.c_str() + 8);
+                return 0;
+            }
+        }
+        else if (arg.rfind("--tile=", 0) == 0)
+        {
+            if (1 != sscanf(arg.c_str() + 7, "%zu", &settings.tile_size) || settings.tile_size == 0)
+            {
+                printf("invalid tile size \"%s\"\n", arg.c_str() + 7);
+                return 0;
+            }
+        }
+        else if (arg.rfind("--rule=", 0) == 0)
+        {
+            std::optional<LtlRule> parsed = parse_ltl_rule(arg.substr(7));
+
+            if (!parsed)
+            {
+                printf("invalid larger than life rule \"%s\"\n", arg.c_str() + 7);
+                return 0;
+            }
+
+            settings.ltl_rule = *parsed;
+            has_rule = true;
+        }
+        else if (arg.rfind("--archive=", 0) == 0)
+        {
+            archive_file = arg.substr(10);
+        }
+        else if (arg.rfind("--extract=", 0) == 0)
+        {
+            extract_file = arg.substr(10);
+        }
+        else if (arg.rfind("--serve=", 0) == 0)
+        {
+            serve_path = arg.substr(8);
+        }
+        else if (arg.rfind("--", 0) == 0)
+        {
+            printf("unknown option \"%s\"\n", arg.c_str());
+            return 0;
+        }
+        else
+        {
+            positional.push_back(argv[index]);
+        }
+    }
+
+    if (!extract_file.empty())
+    {
+        return extract_history(extract_file, positional);
+    }
+
+    if (settings.engine == Engine::Temporal && !archive_file.empty())
+    {
+        // the archive needs every generation, the temporal engine only
+        // produces every depth-th one
+        printf("the temporal engine can not write a history archive\n");
+        return 0;
+    }
+
+    if (!write_output && !archive_file.empty())
+    {
+        printf("--no-output can not be used with --archive\n");
+        return 0;
+    }
+
+    if (has_rule && settings.engine != Engine::LargerThanLife)
+    {
+        printf("a rule can only be given to the ltl engine\n");
+        return 0;
+    }
+
+    if (!serve_path.empty())
+    {
+        return serve(serve_path, settings);
+    }
+
+    if (positional.size() < 1)
+    {
+        printf("provide a file to start the game\n");
+        return 0;
+    }
+
+    if (positional.size() == 2)
+    {
+        if (1 != sscanf(positional[1], "%zu", &generations))
+        {
+            printf("failed to parse generations amount \"%s\"", positional[1]);
+            return 0;
+        }
+    }
+
+    if (generations == 0)
+    {
+        printf("generations specified is zero\n");
+        return 0;
+    }
+
+    std::string error;
+    std::unique_ptr<World> loaded = load_world(positional[0], settings.track_alive(), error);
+
+    if (!loaded)
+    {
+        printf("%s\n", error.c_str());
+        return 0;
+    }
+
+    World& world = *loaded;
+    size_t x_size = world.x_size;
+    size_t y_size = world.y_size;
+
+    if (write_output && !world.to_file("initial.txt"))
+    {
+        printf("failed to output initial state to file");
+        return 0;
     }
 
     printf("running for %zu generations\n", generations);
 
     size_t current_gen = 1;
+    LookupTable table(world.rule);
+    std::optional<HistoryWriter> archive;
+
+    if (!archive_file.empty())
+    {
+        archive.emplace(x_size, y_size);
+
+        if (!archive->open(archive_file))
+        {
+            printf("failed to open history archive \"%s\"\n", archive_file.c_str());
+            return 0;
+        }
+    }
+
+    // every generation written out is a full board, --no-output leaves
+    // memory use to what the pattern touches
+    std::optional<OutputPipeline> output;
+    RunMetrics metrics;
+
+    if (write_output)
+    {
+        output.emplace(x_size, y_size, archive ? &*archive : nullptr);
+    }
+
+    if (archive)
+    {
+        output->push(world, 0);
+    }
 
     // begin the game of life
-    while (generations--)
+    while (generations != 0)
     {
+        size_t allocations = allocation_count.load(std::memory_order_relaxed);
+
+        // the temporal engine only stops every depth generations
+        size_t steps = settings.engine == Engine::Temporal ?
+            std::min(settings.depth, generations) :
+            1;
+
+        current_gen += steps - 1;
+        generations -= steps;
+
         printf("---------- processing generation %zu\n", current_gen);
-        world.tick();
-        world.update();
 
-        std::ostringstream output_name;
+        auto start = std::chrono::steady_clock::now();
+
+        advance(world, settings, table, steps);
 
-        output_name << "generation_" << current_gen << ".txt";
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        if (output)
+        {
+            output->push(world, current_gen);
+        }
 
-        world.to_file(output_name.str());
+        metrics.record_generation(
+            current_gen,
+            steps,
+            allocation_count.load(std::memory_order_relaxed) - allocations,
+            elapsed
+        );
 
         current_gen += 1;
     }
 
+    if (output)
+    {
+        output->finish();
+    }
+
+    if (archive && !archive->finish())
+    {
+        printf("failed to write history archive \"%s\"\n", archive_file.c_str());
+    }
+
+    metrics.print();
+
     return 0;
 }
 